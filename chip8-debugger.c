@@ -0,0 +1,343 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// Interactive console debugger for the Chip-8 core.
+// Only compiled in when CHIP8_DEBUG is defined: main.c then calls CHIP8_DEBUG_EMULATECYCLE instead of
+// CHIP8_EMULATECYCLE, so breakpoint checks never touch the normal dispatch path.
+//
+// Commands (addresses, opcodes and masks are hex; counts, lengths and breakpoint numbers are decimal):
+//   s              step one instruction
+//   n              step over (runs a 2nnn call until it returns)
+//   c              continue until a breakpoint is hit
+//   b   <addr>     break when pc reaches addr
+//   bo  <op> [mask] break when (opcode & mask) == op (mask defaults to FFFF)
+//   bw  <addr>     break before an instruction writes memory at addr
+//   d   <n>        delete breakpoint n (as numbered by "i")
+//   i              list breakpoints
+//   r              show registers and timers
+//   k              show stack
+//   x   <addr> [len] dump memory
+//   l   [addr] [count] disassemble (defaults to pc)
+//   q              quit the emulator
+
+#define MAXBREAKPOINTS 32
+#define DEBUGLINESIZE 64
+
+// Breakpoint kinds
+#define BREAK_PC     0
+#define BREAK_OPCODE 1
+#define BREAK_WRITE  2
+
+typedef struct {
+    int kind;
+    unsigned short value; // pc, opcode or memory address depending on kind
+    unsigned short mask;  // only used by BREAK_OPCODE
+} CHIP8_BREAKPOINT;
+
+CHIP8_BREAKPOINT breakpoints[MAXBREAKPOINTS];
+int breakpointCount;
+
+// start paused so breakpoints can be placed before the program runs
+bool debug_paused = true;
+
+// set when stdin closes: the program keeps running without further prompts
+bool debug_detached = false;
+
+// time spent at the prompt is not emulated time, so the next deltaTime is discarded.
+// main.c also reads it after each cycle to leave stopped frames out of the metrics.
+bool debug_discardDelta = false;
+
+// step over state: pause once pc returns to stepOverPc at the same stack depth
+bool stepOverActive = false;
+unsigned short stepOverPc;
+unsigned short stepOverSp;
+
+// Finds the memory range an opcode is about to write to. Returns false if it does not write memory.
+bool CHIP8_DEBUG_WRITERANGE(unsigned short op, unsigned short *start, unsigned short *length)
+{
+    if ((op & 0xF000) != 0xF000) {
+        return false;
+    }
+    switch(op & 0x00FF)
+    {
+        case 0x0033:
+            *start  = I;
+            *length = 3;
+            return true;
+
+        case 0x0055:
+            *start  = I;
+            *length = ((op & 0x0F00) >> 8) + 1;
+            return true;
+    }
+    return false;
+}
+
+// Checks every breakpoint against the instruction at pc. Prints the reason and returns true on a hit.
+bool CHIP8_DEBUG_CHECKBREAKPOINTS()
+{
+    unsigned short op = memory[pc] << 8 | memory[pc + 1];
+
+    if (stepOverActive && pc == stepOverPc && sp == stepOverSp) {
+        stepOverActive = false;
+        return true;
+    }
+
+    unsigned short writeStart = 0;
+    unsigned short writeLength = 0;
+    bool writes = CHIP8_DEBUG_WRITERANGE(op, &writeStart, &writeLength);
+
+    for (int i = 0; i < breakpointCount; i++) {
+        CHIP8_BREAKPOINT *bp = &breakpoints[i];
+        switch(bp->kind)
+        {
+            case BREAK_PC:
+                if (pc == bp->value) {
+                    printf("Breakpoint %d: pc == %03X\n", i, bp->value);
+                    return true;
+                }
+            break;
+
+            case BREAK_OPCODE:
+                if ((op & bp->mask) == bp->value) {
+                    printf("Breakpoint %d: opcode %04X matches %04X/%04X\n", i, op, bp->value, bp->mask);
+                    return true;
+                }
+            break;
+
+            case BREAK_WRITE:
+                if (writes && bp->value >= writeStart && bp->value < writeStart + writeLength) {
+                    printf("Breakpoint %d: write to %03X\n", i, bp->value);
+                    return true;
+                }
+            break;
+        }
+    }
+    return false;
+}
+
+bool CHIP8_DEBUG_ADDBREAKPOINT(int kind, unsigned short value, unsigned short mask)
+{
+    if (breakpointCount == MAXBREAKPOINTS) {
+        fprintf(stderr, "Cannot add more than %d breakpoints\n", MAXBREAKPOINTS);
+        return false;
+    }
+    breakpoints[breakpointCount].kind  = kind;
+    breakpoints[breakpointCount].value = value;
+    breakpoints[breakpointCount].mask  = mask;
+    printf("Breakpoint %d set\n", breakpointCount);
+    breakpointCount++;
+    return true;
+}
+
+void CHIP8_DEBUG_LISTBREAKPOINTS()
+{
+    if (breakpointCount == 0) {
+        printf("No breakpoints\n");
+    }
+    for (int i = 0; i < breakpointCount; i++) {
+        switch(breakpoints[i].kind)
+        {
+            case BREAK_PC:     printf("%2d: pc     %03X\n", i, breakpoints[i].value); break;
+            case BREAK_OPCODE: printf("%2d: opcode %04X/%04X\n", i, breakpoints[i].value, breakpoints[i].mask); break;
+            case BREAK_WRITE:  printf("%2d: write  %03X\n", i, breakpoints[i].value); break;
+        }
+    }
+}
+
+bool CHIP8_DEBUG_ISPCBREAKPOINT(unsigned short addr)
+{
+    for (int i = 0; i < breakpointCount; i++) {
+        if (breakpoints[i].kind == BREAK_PC && breakpoints[i].value == addr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Prints count instructions starting at addr, marking pc with "=>" and pc breakpoints with "*"
+void CHIP8_DEBUG_DISASSEMBLE(unsigned short addr, int count)
+{
+    for (int i = 0; i < count && addr + 1 < MEMORYSIZE; i++, addr += 2) {
+        unsigned short op = memory[addr] << 8 | memory[addr + 1];
+        printf("%s%c %03X | %04X | ", addr == pc ? "=>" : "  ", CHIP8_DEBUG_ISPCBREAKPOINT(addr) ? '*' : ' ', addr, op);
+        CHIP8_DISASSEMBLE(stdout, op);
+    }
+}
+
+void CHIP8_DEBUG_REGISTERS()
+{
+    for (int i = 0; i < REGISTERCOUNT; i++) {
+        printf("V%01X=%02X%s", i, V[i], (i % 8 == 7) ? "\n" : " ");
+    }
+    printf("I=%03X pc=%03X sp=%X DT=%02X ST=%02X\n", I, pc, sp, delay_timer, sound_timer);
+}
+
+void CHIP8_DEBUG_STACK()
+{
+    if (sp == 0) {
+        printf("Stack is empty\n");
+    }
+    // innermost call first
+    for (int i = sp - 1; i >= 0; i--) {
+        printf("#%d %03X\n", i, stack[i]);
+    }
+}
+
+void CHIP8_DEBUG_MEMORY(unsigned short addr, int length)
+{
+    for (int i = 0; i < length && addr + i < MEMORYSIZE; i++) {
+        if (i % 16 == 0) {
+            printf("%s%03X:", i == 0 ? "" : "\n", addr + i);
+        }
+        printf(" %02X", memory[addr + i]);
+    }
+    printf("\n");
+}
+
+// Parses a whole argument in the given base into result. Fails on empty or trailing text and on values outside min..max.
+bool CHIP8_DEBUG_PARSE(const char *text, int base, long min, long max, long *result)
+{
+    char *end;
+    long parsed = strtol(text, &end, base);
+    if (end == text || *end != '\0' || parsed < min || parsed > max) {
+        return false;
+    }
+    *result = parsed;
+    return true;
+}
+
+// Reads commands until one of them resumes execution. Returns 3 if the user asked to quit.
+int CHIP8_DEBUG_PROMPT()
+{
+    char line[DEBUGLINESIZE];
+    char command[DEBUGLINESIZE];
+    char arg1[DEBUGLINESIZE];
+    char arg2[DEBUGLINESIZE];
+
+    // any pause cancels a step over that has not returned yet
+    stepOverActive = false;
+
+    CHIP8_DEBUG_DISASSEMBLE(pc, 1);
+
+    while (true) {
+        printf("(chip8) ");
+        fflush(stdout);
+
+        if (fgets(line, DEBUGLINESIZE, stdin) == NULL) {
+            printf("\nstdin closed, detaching debugger\n");
+            debug_detached = true;
+            debug_paused = false;
+            return 0;
+        }
+
+        int args = sscanf(line, "%63s %63s %63s", command, arg1, arg2);
+        if (args < 1) {
+            continue;
+        }
+        // set by any command whose arguments are missing or fail to parse
+        bool valid = true;
+        long value = 0;
+        long extra = 0;
+
+        if (strcmp(command, "s") == 0) {
+            debug_paused = true;
+            return 0;
+        } else if (strcmp(command, "n") == 0) {
+            unsigned short op = memory[pc] << 8 | memory[pc + 1];
+            if ((op & 0xF000) == 0x2000) {
+                stepOverActive = true;
+                stepOverPc = pc + 2;
+                stepOverSp = sp;
+                debug_paused = false;
+            } else {
+                debug_paused = true;
+            }
+            return 0;
+        } else if (strcmp(command, "c") == 0) {
+            debug_paused = false;
+            return 0;
+        } else if (strcmp(command, "q") == 0) {
+            return 3;
+        } else if (strcmp(command, "b") == 0) {
+            valid = args >= 2 && CHIP8_DEBUG_PARSE(arg1, 16, 0, MEMORYSIZE - 1, &value);
+            if (valid) {
+                CHIP8_DEBUG_ADDBREAKPOINT(BREAK_PC, value, 0xFFFF);
+            }
+        } else if (strcmp(command, "bo") == 0) {
+            extra = 0xFFFF;
+            valid = args >= 2 && CHIP8_DEBUG_PARSE(arg1, 16, 0, 0xFFFF, &value)
+                 && (args < 3 || CHIP8_DEBUG_PARSE(arg2, 16, 0, 0xFFFF, &extra));
+            if (valid) {
+                CHIP8_DEBUG_ADDBREAKPOINT(BREAK_OPCODE, value & extra, extra);
+            }
+        } else if (strcmp(command, "bw") == 0) {
+            valid = args >= 2 && CHIP8_DEBUG_PARSE(arg1, 16, 0, MEMORYSIZE - 1, &value);
+            if (valid) {
+                CHIP8_DEBUG_ADDBREAKPOINT(BREAK_WRITE, value, 0xFFFF);
+            }
+        } else if (strcmp(command, "d") == 0) {
+            valid = args >= 2 && CHIP8_DEBUG_PARSE(arg1, 10, 0, MAXBREAKPOINTS - 1, &value);
+            if (valid && value >= breakpointCount) {
+                fprintf(stderr, "No breakpoint %ld\n", value);
+            } else if (valid) {
+                memmove(&breakpoints[value], &breakpoints[value + 1], (breakpointCount - value - 1) * sizeof(CHIP8_BREAKPOINT));
+                breakpointCount--;
+            }
+        } else if (strcmp(command, "i") == 0) {
+            CHIP8_DEBUG_LISTBREAKPOINTS();
+        } else if (strcmp(command, "r") == 0) {
+            CHIP8_DEBUG_REGISTERS();
+        } else if (strcmp(command, "k") == 0) {
+            CHIP8_DEBUG_STACK();
+        } else if (strcmp(command, "x") == 0) {
+            extra = 16;
+            valid = args >= 2 && CHIP8_DEBUG_PARSE(arg1, 16, 0, MEMORYSIZE - 1, &value)
+                 && (args < 3 || CHIP8_DEBUG_PARSE(arg2, 10, 1, MEMORYSIZE, &extra));
+            if (valid) {
+                CHIP8_DEBUG_MEMORY(value, extra);
+            }
+        } else if (strcmp(command, "l") == 0) {
+            value = pc;
+            extra = 8;
+            valid = (args < 2 || CHIP8_DEBUG_PARSE(arg1, 16, 0, MEMORYSIZE - 1, &value))
+                 && (args < 3 || CHIP8_DEBUG_PARSE(arg2, 10, 1, MEMORYSIZE / 2, &extra));
+            if (valid) {
+                CHIP8_DEBUG_DISASSEMBLE(value, extra);
+            }
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            printf("Commands: s, n, c, q, b <addr>, bo <op> [mask], bw <addr>, d <n>, i, r, k, x <addr> [len], l [addr] [count]\n");
+            printf("addr (000-%03X), op and mask (0000-FFFF) are hex; n, len and count are decimal\n", MEMORYSIZE - 1);
+        }
+    }
+}
+
+// Instrumented replacement for CHIP8_EMULATECYCLE. Same return codes, plus 3 when the user quits from the prompt.
+int CHIP8_DEBUG_EMULATECYCLE(double deltaTime)
+{
+    if (debug_discardDelta) {
+        deltaTime = 0;
+        debug_discardDelta = false;
+    }
+
+    if (!debug_detached) {
+        if (!debug_paused && CHIP8_DEBUG_CHECKBREAKPOINTS()) {
+            debug_paused = true;
+        }
+
+        if (debug_paused) {
+            if (CHIP8_DEBUG_PROMPT() == 3) {
+                return 3;
+            }
+            debug_discardDelta = true;
+        }
+    }
+
+    return CHIP8_EMULATECYCLE(deltaTime);
+}
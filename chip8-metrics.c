@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "SDL2/SDL.h"
+
+// Frame timing and throughput metrics.
+// main.c reports each frame's section times through CHIP8_METRICS_ENDFRAME. Values are kept in fixed-size
+// histograms, so recording a frame costs a few additions and no allocation. Every METRICS_DUMPINTERVAL
+// milliseconds a summary line is appended to METRICS_DUMPFILE, and the current window is reset.
+
+// one frame at 60 Hz, in ms
+#define FRAMEBUDGET (1000/60.0)
+
+// a frame only counts as late past this, so vsync jitter around FRAMEBUDGET is not reported.
+// 1.5 budgets means the frame missed at least one vblank.
+#define LATEFRAMETHRESHOLD (1.5 * FRAMEBUDGET)
+
+#define METRICS_DUMPINTERVAL 5000
+#define METRICS_FORMAT_JSON 0
+#define METRICS_FORMAT_CSV  1
+#ifndef METRICS_DUMPFORMAT
+#define METRICS_DUMPFORMAT METRICS_FORMAT_JSON
+#endif
+#ifndef METRICS_DUMPFILE
+#if METRICS_DUMPFORMAT == METRICS_FORMAT_CSV
+#define METRICS_DUMPFILE "chip8-metrics.csv"
+#else
+#define METRICS_DUMPFILE "chip8-metrics.jsonl"
+#endif
+#endif
+
+// number of recent frames kept for the overlay graph
+#define METRICS_HISTORYSIZE 128
+
+#define HISTOGRAMBUCKETS 34
+
+typedef struct {
+    double bucketWidth;
+    unsigned long buckets[HISTOGRAMBUCKETS]; // last bucket also holds every value past the range
+    unsigned long count;
+    double sum;
+    double min;
+    double max;
+} CHIP8_HISTOGRAM;
+
+// histograms for the current dump window
+CHIP8_HISTOGRAM frameTimeHist     = { .bucketWidth = 1.0 };  // ms
+CHIP8_HISTOGRAM emulateTimeHist   = { .bucketWidth = 0.25 }; // ms
+CHIP8_HISTOGRAM renderTimeHist    = { .bucketWidth = 0.25 }; // ms
+CHIP8_HISTOGRAM presentTimeHist   = { .bucketWidth = 0.25 }; // ms
+CHIP8_HISTOGRAM cyclesHist        = { .bucketWidth = 1.0 };  // instructions per frame
+CHIP8_HISTOGRAM timerTicksHist    = { .bucketWidth = 1.0 };  // timer ticks per frame, more than 1 means the timers caught up in a burst
+CHIP8_HISTOGRAM accumulatorHist   = { .bucketWidth = 1.0 };  // ms left in the accumulator after the timers ran
+
+// counters for the current dump window
+unsigned long windowFrames;
+unsigned long windowLateFrames;
+unsigned long windowDroppedFrames;
+double windowTime; // ms
+
+// counters since startup
+unsigned long totalFrames;
+unsigned long totalCycles;
+unsigned long totalLateFrames;
+unsigned long totalDroppedFrames;
+unsigned long totalTicks; // timer ticks in recorded frames, compared against totalTime to find drift
+double totalTime; // ms
+
+// recent frame times for the overlay
+double frameHistory[METRICS_HISTORYSIZE];
+int frameHistoryPos;
+int frameHistoryCount; // slots filled so far, stops at METRICS_HISTORYSIZE
+unsigned long lastCycles;
+
+bool overlayVisible = false;
+
+FILE *metricsFile = NULL;
+
+// wall-clock start of this run, written on every line so lines from different runs appended to one file can be told apart
+time_t metricsRunStart;
+
+void CHIP8_HISTOGRAM_ADD(CHIP8_HISTOGRAM *hist, double value)
+{
+    int bucket = (int)(value / hist->bucketWidth);
+    if (bucket < 0) {
+        bucket = 0;
+    } else if (bucket >= HISTOGRAMBUCKETS) {
+        bucket = HISTOGRAMBUCKETS - 1;
+    }
+    hist->buckets[bucket]++;
+
+    if (hist->count == 0 || value < hist->min) {
+        hist->min = value;
+    }
+    if (hist->count == 0 || value > hist->max) {
+        hist->max = value;
+    }
+    hist->count++;
+    hist->sum += value;
+}
+
+void CHIP8_HISTOGRAM_RESET(CHIP8_HISTOGRAM *hist)
+{
+    double bucketWidth = hist->bucketWidth;
+    memset(hist, 0, sizeof(CHIP8_HISTOGRAM));
+    hist->bucketWidth = bucketWidth;
+}
+
+double CHIP8_HISTOGRAM_MEAN(CHIP8_HISTOGRAM *hist)
+{
+    return hist->count ? hist->sum / hist->count : 0;
+}
+
+// Upper edge of the bucket holding the given nearest-rank percentile (0-100), clamped to the largest value seen.
+// The last bucket has no upper edge, so a percentile landing there reports the largest value seen.
+double CHIP8_HISTOGRAM_PERCENTILE(CHIP8_HISTOGRAM *hist, double percentile)
+{
+    if (hist->count == 0) {
+        return 0;
+    }
+    // rank of the sample, rounded up
+    double rank = hist->count * percentile / 100.0;
+    unsigned long target = (unsigned long)rank;
+    if (target < rank) {
+        target++;
+    }
+    if (target == 0) {
+        target = 1;
+    }
+    unsigned long seen = 0;
+    for (int i = 0; i < HISTOGRAMBUCKETS - 1; i++) {
+        seen += hist->buckets[i];
+        if (seen >= target) {
+            double edge = (i + 1) * hist->bucketWidth;
+            return edge < hist->max ? edge : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+int CHIP8_METRICS_INITIALIZE()
+{
+    metricsRunStart = time(NULL);
+
+    metricsFile = fopen(METRICS_DUMPFILE, "a");
+    if (metricsFile == NULL) {
+        fprintf(stderr, "Error opening metrics file %s, metrics will not be dumped\n", METRICS_DUMPFILE);
+        return 1;
+    }
+
+    // new csv files need a header. the starting position of an append stream is implementation-defined, so seek first
+    fseek(metricsFile, 0, SEEK_END);
+    if (METRICS_DUMPFORMAT == METRICS_FORMAT_CSV && ftell(metricsFile) == 0) {
+        fprintf(metricsFile, "unix_time,run_start,time_s,frames,fps,cycles_per_frame,frame_ms_mean,frame_ms_p50,frame_ms_p95,frame_ms_p99,frame_ms_max,"
+                             "emulate_ms_mean,emulate_ms_max,render_ms_mean,render_ms_max,present_ms_mean,present_ms_max,"
+                             "timer_ticks,expected_ticks,accumulator_ms_max,max_ticks_per_frame,late_frames,dropped_frames,total_late_frames,total_dropped_frames,total_frames,total_instructions\n");
+    }
+    return 0;
+}
+
+void CHIP8_METRICS_DUMP()
+{
+    if (metricsFile == NULL || windowFrames == 0) {
+        return;
+    }
+
+    double fps = windowFrames * 1000.0 / windowTime;
+    double expectedTicks = totalTime / FRAMEBUDGET;
+
+    if (METRICS_DUMPFORMAT == METRICS_FORMAT_CSV) {
+        fprintf(metricsFile, "%lld,%lld,%.3f,%lu,%.2f,%.2f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%lu,%.1f,%.3f,%.0f,%lu,%lu,%lu,%lu,%lu,%lu\n",
+            (long long)time(NULL), (long long)metricsRunStart, totalTime / 1000.0, windowFrames, fps, CHIP8_HISTOGRAM_MEAN(&cyclesHist),
+            CHIP8_HISTOGRAM_MEAN(&frameTimeHist), CHIP8_HISTOGRAM_PERCENTILE(&frameTimeHist, 50),
+            CHIP8_HISTOGRAM_PERCENTILE(&frameTimeHist, 95), CHIP8_HISTOGRAM_PERCENTILE(&frameTimeHist, 99), frameTimeHist.max,
+            CHIP8_HISTOGRAM_MEAN(&emulateTimeHist), emulateTimeHist.max,
+            CHIP8_HISTOGRAM_MEAN(&renderTimeHist), renderTimeHist.max,
+            CHIP8_HISTOGRAM_MEAN(&presentTimeHist), presentTimeHist.max,
+            totalTicks, expectedTicks, accumulatorHist.max, timerTicksHist.max,
+            windowLateFrames, windowDroppedFrames, totalLateFrames, totalDroppedFrames, totalFrames, totalCycles);
+    } else {
+        fprintf(metricsFile, "{\"unix_time\":%lld,\"run_start\":%lld,\"time_s\":%.3f,\"frames\":%lu,\"fps\":%.2f,\"cycles_per_frame\":%.2f,"
+                             "\"frame_ms\":{\"mean\":%.3f,\"p50\":%.3f,\"p95\":%.3f,\"p99\":%.3f,\"max\":%.3f},"
+                             "\"emulate_ms\":{\"mean\":%.3f,\"max\":%.3f},\"render_ms\":{\"mean\":%.3f,\"max\":%.3f},\"present_ms\":{\"mean\":%.3f,\"max\":%.3f},"
+                             "\"timer\":{\"ticks\":%lu,\"expected_ticks\":%.1f,\"accumulator_ms_max\":%.3f,\"max_ticks_per_frame\":%.0f},"
+                             "\"late_frames\":%lu,\"dropped_frames\":%lu,\"total_late_frames\":%lu,\"total_dropped_frames\":%lu,\"total_frames\":%lu,\"total_instructions\":%lu}\n",
+            (long long)time(NULL), (long long)metricsRunStart, totalTime / 1000.0, windowFrames, fps, CHIP8_HISTOGRAM_MEAN(&cyclesHist),
+            CHIP8_HISTOGRAM_MEAN(&frameTimeHist), CHIP8_HISTOGRAM_PERCENTILE(&frameTimeHist, 50),
+            CHIP8_HISTOGRAM_PERCENTILE(&frameTimeHist, 95), CHIP8_HISTOGRAM_PERCENTILE(&frameTimeHist, 99), frameTimeHist.max,
+            CHIP8_HISTOGRAM_MEAN(&emulateTimeHist), emulateTimeHist.max,
+            CHIP8_HISTOGRAM_MEAN(&renderTimeHist), renderTimeHist.max,
+            CHIP8_HISTOGRAM_MEAN(&presentTimeHist), presentTimeHist.max,
+            totalTicks, expectedTicks, accumulatorHist.max, timerTicksHist.max,
+            windowLateFrames, windowDroppedFrames, totalLateFrames, totalDroppedFrames, totalFrames, totalCycles);
+    }
+    fflush(metricsFile);
+
+    CHIP8_HISTOGRAM_RESET(&frameTimeHist);
+    CHIP8_HISTOGRAM_RESET(&emulateTimeHist);
+    CHIP8_HISTOGRAM_RESET(&renderTimeHist);
+    CHIP8_HISTOGRAM_RESET(&presentTimeHist);
+    CHIP8_HISTOGRAM_RESET(&cyclesHist);
+    CHIP8_HISTOGRAM_RESET(&timerTicksHist);
+    CHIP8_HISTOGRAM_RESET(&accumulatorHist);
+    windowFrames = 0;
+    windowLateFrames = 0;
+    windowDroppedFrames = 0;
+    windowTime = 0;
+}
+
+// Records one frame. frameTime is how long this loop iteration took in ms, from its start to the end of present.
+// The section times are performance counter deltas for the same iteration.
+void CHIP8_METRICS_ENDFRAME(double frameTime, unsigned long cycles, unsigned long frameTicks, Uint64 emulateCounts, Uint64 renderCounts, Uint64 presentCounts)
+{
+    double toMs = 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+    CHIP8_HISTOGRAM_ADD(&frameTimeHist, frameTime);
+    CHIP8_HISTOGRAM_ADD(&emulateTimeHist, emulateCounts * toMs);
+    CHIP8_HISTOGRAM_ADD(&renderTimeHist, renderCounts * toMs);
+    CHIP8_HISTOGRAM_ADD(&presentTimeHist, presentCounts * toMs);
+    CHIP8_HISTOGRAM_ADD(&cyclesHist, cycles);
+    CHIP8_HISTOGRAM_ADD(&timerTicksHist, frameTicks);
+    CHIP8_HISTOGRAM_ADD(&accumulatorHist, accumulator);
+
+    // late: the frame missed a vblank. dropped: periods, to the nearest whole one, that passed without a frame
+    if (frameTime > LATEFRAMETHRESHOLD) {
+        windowLateFrames++;
+        totalLateFrames++;
+        unsigned long dropped = (unsigned long)(frameTime / FRAMEBUDGET + 0.5) - 1;
+        windowDroppedFrames += dropped;
+        totalDroppedFrames  += dropped;
+    }
+
+    windowFrames++;
+    totalFrames++;
+    totalCycles += cycles;
+    totalTicks  += frameTicks;
+    lastCycles = cycles;
+    windowTime += frameTime;
+    totalTime  += frameTime;
+
+    frameHistory[frameHistoryPos] = frameTime;
+    frameHistoryPos = (frameHistoryPos + 1) % METRICS_HISTORYSIZE;
+    if (frameHistoryCount < METRICS_HISTORYSIZE) {
+        frameHistoryCount++;
+    }
+
+    if (windowTime >= METRICS_DUMPINTERVAL) {
+        CHIP8_METRICS_DUMP();
+    }
+}
+
+// Draws a number using the built-in font set, scale pixels per font pixel. Returns the x position after the last digit.
+int CHIP8_METRICS_DRAWNUMBER(SDL_Renderer *renderer, int x, int y, int scale, unsigned long value)
+{
+    char digits[24];
+    int length = snprintf(digits, sizeof(digits), "%lu", value);
+    SDL_Rect pixel;
+    pixel.w = scale;
+    pixel.h = scale;
+
+    for (int d = 0; d < length; d++) {
+        unsigned char *glyph = &chip8_fontset[(digits[d] - '0') * 5];
+        for (int row = 0; row < 5; row++) {
+            for (int col = 0; col < 4; col++) {
+                if (glyph[row] & (0x80 >> col)) {
+                    pixel.x = x + col * scale;
+                    pixel.y = y + row * scale;
+                    SDL_RenderFillRect(renderer, &pixel);
+                }
+            }
+        }
+        x += 5 * scale;
+    }
+    return x;
+}
+
+// Overlay: fps (white), instructions per frame (yellow), late frames since startup (red),
+// and a graph of recent frame times along the bottom with the 60 Hz budget as a yellow line.
+void CHIP8_METRICS_DRAWOVERLAY(SDL_Renderer *renderer, int windowX, int windowY)
+{
+    if (!overlayVisible) {
+        return;
+    }
+
+    double historySum = 0;
+    for (int i = 0; i < METRICS_HISTORYSIZE; i++) {
+        historySum += frameHistory[i];
+    }
+    unsigned long fps = historySum > 0 ? (unsigned long)(frameHistoryCount * 1000.0 / historySum) : 0;
+
+    int scale = 2;
+    int x = 4;
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    x = CHIP8_METRICS_DRAWNUMBER(renderer, x, 4, scale, fps) + 4 * scale;
+    SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
+    x = CHIP8_METRICS_DRAWNUMBER(renderer, x, 4, scale, lastCycles) + 4 * scale;
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+    CHIP8_METRICS_DRAWNUMBER(renderer, x, 4, scale, totalLateFrames);
+
+    // 2 pixels per ms, capped at two frame budgets
+    int pixelsPerMs = 2;
+    int graphHeight = (int)(2 * FRAMEBUDGET * pixelsPerMs);
+    SDL_Rect bar;
+    bar.w = windowX / METRICS_HISTORYSIZE;
+    for (int i = 0; i < METRICS_HISTORYSIZE; i++) {
+        // oldest frame on the left
+        double frameTime = frameHistory[(frameHistoryPos + i) % METRICS_HISTORYSIZE];
+        bar.h = (int)(frameTime * pixelsPerMs);
+        if (bar.h > graphHeight) {
+            bar.h = graphHeight;
+        }
+        bar.x = i * bar.w;
+        bar.y = windowY - bar.h;
+        if (frameTime > LATEFRAMETHRESHOLD) {
+            SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+        } else {
+            SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+        }
+        SDL_RenderFillRect(renderer, &bar);
+    }
+
+    SDL_Rect budgetLine;
+    budgetLine.x = 0;
+    budgetLine.y = windowY - (int)(FRAMEBUDGET * pixelsPerMs);
+    budgetLine.w = windowX;
+    budgetLine.h = 1;
+    SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
+    SDL_RenderFillRect(renderer, &budgetLine);
+}
+
+void CHIP8_METRICS_CLOSE()
+{
+    CHIP8_METRICS_DUMP();
+    if (metricsFile != NULL && fclose(metricsFile) == EOF) {
+        fprintf(stderr, "Error closing metrics file\n");
+    }
+    metricsFile = NULL;
+}
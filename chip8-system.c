@@ -53,6 +53,12 @@ unsigned char sound_timer;
 // 60 Hz accumulator that increments by deltaTime. When it reaches 1/60th of a second, subtracts 1/60th of a second and decrements timers
 double accumulator;
 
+// total number of 60 Hz timer ticks since startup, used by metrics to measure timer drift
+unsigned long timerTicks;
+
+// total number of opcodes that finished executing, used by metrics to count instructions per frame
+unsigned long instructionsExecuted;
+
 // Stack. Used to remember the location before a jump is performed.
 #define STACKSIZE 16
 unsigned short stack[STACKSIZE];
@@ -148,9 +154,93 @@ int CHIP8_TIMERDECREMENT()
     if (sound_timer > 0) {
         sound_timer--;
     }
+    timerTicks++;
     return 0;
 }
 
+// Prints a human-readable description of an opcode, followed by a newline.
+// Decoding follows the same masks as CHIP8_EMULATECYCLE, so the emulator trace and the debugger listing always agree.
+// if opcode is implemented, description will start with "# "
+void CHIP8_DISASSEMBLE(FILE *out, unsigned short op) 
+{
+    unsigned char  x   = (op & 0x0F00) >> 8;
+    unsigned char  y   = (op & 0x00F0) >> 4;
+    unsigned char  n   = (op & 0x000F);
+    unsigned short nnn = (op & 0x0FFF);
+    unsigned char  kk  = (op & 0x00FF);
+
+    switch(op & 0xF000) // mask first 4 bits
+    {
+        case 0x0000:
+            switch(op & 0x000F)
+            {
+                case 0x0000: fprintf(out, "# Clear Screen\n"); break;
+                case 0x000E: fprintf(out, "# Return from subroutine\n"); break;
+                default:     fprintf(out, "Unknown opcode: 0x%X\n", op);
+            }
+        break;
+
+        case 0x1000: fprintf(out, "# Jump to location %03X\n", nnn); break;
+        case 0x2000: fprintf(out, "# Call Subroutine at %03X\n", nnn); break;
+        case 0x3000: fprintf(out, "# Skip next if V%01X == %02X\n", x, kk); break;
+        case 0x4000: fprintf(out, "# Skip next if V%01X != %02X\n", x, kk); break;
+        case 0x5000: fprintf(out, "# Skip next if V%01X == V%01X\n", x, y); break;
+        case 0x6000: fprintf(out, "# Set register V%01X to %02X\n", x, kk); break;
+        case 0x7000: fprintf(out, "# Set V%01X to V%01X + %02X\n", x, x, kk); break;
+
+        case 0x8000:
+            // various operations on 2 registers
+            switch(op & 0x000F) 
+            {
+                case 0x0000: fprintf(out, "# Set V%01X to V%01X\n", x, y); break;
+                case 0x0001: fprintf(out, "# Set V%01X = V%01X OR V%01X\n", x, x, y); break;
+                case 0x0002: fprintf(out, "# Set V%01X = V%01X AND V%01X\n", x, x, y); break;
+                case 0x0003: fprintf(out, "# Set V%01X = V%01X XOR V%01X\n", x, x, y); break;
+                case 0x0004: fprintf(out, "# Set V%01X = V%01X + V%01X, set VF = carry\n", x, x, y); break;
+                case 0x0005: fprintf(out, "# Set V%01X = V%01X - V%01X, set VF = NOT borrow\n", x, x, y); break;
+                case 0x0006: fprintf(out, "# Set V%01X = V%01X SHR 1. VF set to least-significant bit, then V%01X divided by 2\n", x, x, x); break;
+                case 0x0007: fprintf(out, "# Set V%01X = V%01X - V%01X, set VF = NOT borrow\n", x, y, x); break;
+                case 0x000E: fprintf(out, "# Set V%01X = V%01X SHL 1. VF set to most-significant bit, then V%01X multiplied by 2\n", x, x, x); break;
+                default:     fprintf(out, "Unknown opcode: 0x%X\n", op);
+            }
+        break;
+
+        case 0x9000: fprintf(out, "# Skip next if V%01X != V%01X\n", x, y); break;
+        case 0xA000: fprintf(out, "# Set I = %03X\n", nnn); break;
+        case 0xB000: fprintf(out, "# Jump to location %03X + V0\n", nnn); break;
+        case 0xC000: fprintf(out, "# Set V%01X = random byte AND %02X\n", x, kk); break;
+        case 0xD000: fprintf(out, "# Display %01X-byte sprite starting at memory location I at (V%01X, V%01X), set VF = collision\n", n, x, y); break;
+
+        case 0xE000:
+            switch(op & 0x00FF) 
+            {
+                case 0x009E: fprintf(out, "# Skip next if key with value V%0X pressed\n", x); break;
+                case 0x00A1: fprintf(out, "# Skip next if key with value V%0X not pressed\n", x); break;
+                default:     fprintf(out, "Unknown opcode: 0x%X\n", op);
+            }
+        break;
+
+        case 0xF000:
+            switch(op & 0x00FF)
+            {
+                case 0x0007: fprintf(out, "# Set V%01X = delay timer value\n", x); break;
+                case 0x000A: fprintf(out, "# Wait for a key press, store the value of the key in V%01X\n", x); break;
+                case 0x0015: fprintf(out, "# Set delay timer = V%01X\n", x); break;
+                case 0x0018: fprintf(out, "# Set sound timer = V%01X\n", x); break;
+                case 0x001E: fprintf(out, "# Set I = I + V%01X\n", x); break;
+                case 0x0029: fprintf(out, "# Set I = location of sprite for digit V%01X\n", x); break;
+                case 0x0033: fprintf(out, "# Store BCD representation of V%01X in memory locations I, I+1, I+2\n", x); break;
+                case 0x0055: fprintf(out, "# Store registers V0 through V%01X in memory starting at location I\n", x); break;
+                case 0x0065: fprintf(out, "# Read registers V0 through V%01X from memory starting at location I\n", x); break;
+                default:     fprintf(out, "Unknown opcode: 0x%X\n", op);
+            }
+        break;
+
+        default:
+            fprintf(out, "Unknown opcode: 0x%X\n", op);
+    }
+}
+
 int CHIP8_EMULATECYCLE(double deltaTime) 
 {
     // regardless of opcodes, get current keyboard state
@@ -184,10 +274,15 @@ int CHIP8_EMULATECYCLE(double deltaTime)
     // by default, program increments program counter by 2 every time: however, some functions such as jumps should not.
     bool incPc = true;
 
+    // Fx0A repeats the same opcode until a key is pressed, so those cycles do not complete an instruction
+    bool waitingForKey = false;
+
     if (opcode == 0) {
         return 1;
     }
 
+    CHIP8_DISASSEMBLE(stdout, opcode);
+
     // handle opcode (based on first 4 bits)
     // if opcode has been implemented, description will start with "# "
     switch(opcode & 0xF000) // mask first 4 bits
@@ -196,13 +291,11 @@ int CHIP8_EMULATECYCLE(double deltaTime)
             switch(opcode & 0x000F)
             {
                 case 0x0000:
-                    printf("# Clear Screen\n");
                     // clear screen data
                     memset(gfx, 0, SCREENX*SCREENY);
                 break;
 
                 case 0x000E:
-                    printf("# Return from subroutine\n");
                     // jump back to current stack element (and then automatically step forwards)
                     pc = stack[sp-1u];
                     
@@ -216,20 +309,17 @@ int CHIP8_EMULATECYCLE(double deltaTime)
                     }
                 break;
 
-                default:
-                    printf("Unknown opcode: 0x%X\n", opcode);
+                default: break;
             }
         break;
 
         case 0x1000:
-            printf("# Jump to location %03X\n", opcode & 0x0FFF);
             nnn = opcode & 0x0FFF;
             pc = nnn;
             incPc = false;
         break;
 
         case 0x2000:
-            printf("# Call Subroutine at %03X\n", opcode & 0x0FFF);
             nnn = opcode & 0x0FFF;
             if (sp == 15u) {
                 fprintf(stderr, "Exceeded max subroutine depth of 16\n");
@@ -243,7 +333,6 @@ int CHIP8_EMULATECYCLE(double deltaTime)
         break;
 
         case 0x3000:
-            printf("# Skip next if V%01X == %02X\n", (opcode & 0x0F00) >> 8, opcode & 0x00FF);
             x = (opcode & 0x0F00) >> 8;
             kk = (opcode & 0x00FF);
             if (V[x] == kk) {
@@ -252,7 +341,6 @@ int CHIP8_EMULATECYCLE(double deltaTime)
         break;
 
         case 0x4000:
-            printf("# Skip next if V%01X != %02X\n", (opcode & 0x0F00) >> 8, opcode & 0x00FF);
             x = (opcode & 0x0F00) >> 8;
             kk = (opcode & 0x00FF);
             if (V[x] != kk) {
@@ -261,7 +349,6 @@ int CHIP8_EMULATECYCLE(double deltaTime)
         break;
 
         case 0x5000:
-            printf("# Skip next if V%01X == V%01X\n", (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
             x = (opcode & 0x0F00) >> 8;
             y = (opcode & 0x00F0) >> 4;
             if (V[x] == V[y]) {
@@ -270,14 +357,12 @@ int CHIP8_EMULATECYCLE(double deltaTime)
         break;
 
         case 0x6000:
-            printf("# Set register V%01X to %02X\n", (opcode & 0x0F00) >> 8, opcode & 0x00FF);
             x = (opcode & 0x0F00) >> 8;
             kk = opcode & 0x00FF;
             V[x] = kk;
         break;
 
         case 0x7000:
-            printf("# Set V%01X to V%01X + %02X\n", (opcode & 0x0F00) >> 8, (opcode & 0x0F00) >> 8, (opcode & 0x00FF));
             x = (opcode & 0x0F00) >> 8;
             kk = opcode & 0x00FF;
             V[x] = V[x] + kk;
@@ -288,35 +373,30 @@ int CHIP8_EMULATECYCLE(double deltaTime)
             switch(opcode & 0x000F) 
             {
                 case 0x0000:
-                    printf("# Set V%01X to V%01X\n", (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
                     x = (opcode & 0x0F00) >> 8;
                     y = (opcode & 0x00F0) >> 4;
                     V[x] = V[y];
                 break;
 
                 case 0x0001:
-                    printf("# Set V%01X = V%01X OR V%01X\n", (opcode & 0x0F00) >> 8, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
                     x = (opcode & 0x0F00) >> 8;
                     y = (opcode & 0x00F0) >> 4;
                     V[x] = V[x] | V[y];
                 break;
 
                 case 0x0002:
-                    printf("# Set V%01X = V%01X AND V%01X\n", (opcode & 0x0F00) >> 8, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
                     x = (opcode & 0x0F00) >> 8;
                     y = (opcode & 0x00F0) >> 4;
                     V[x] = V[x] & V[y];
                 break;
 
                 case 0x0003:
-                    printf("# Set V%01X = V%01X XOR V%01X\n", (opcode & 0x0F00) >> 8, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
                     x = (opcode & 0x0F00) >> 8;
                     y = (opcode & 0x00F0) >> 4;
                     V[x] = V[x] ^ V[y];
                 break;
 
                 case 0x0004:
-                    printf("# Set V%01X = V%01X + V%01X, set VF = carry\n", (opcode & 0x0F00) >> 8, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
                     x = (opcode & 0x0F00) >> 8;
                     y = (opcode & 0x00F0) >> 4;
                     if ((int)V[x] + (int)V[y] > 0xFF) {
@@ -328,7 +408,6 @@ int CHIP8_EMULATECYCLE(double deltaTime)
                 break;
 
                 case 0x0005:
-                    printf("# Set V%01X = V%01X - V%01X, set VF = NOT borrow\n", (opcode & 0x0F00) >> 8, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
                     x = (opcode & 0x0F00) >> 8;
                     y = (opcode & 0x00F0) >> 4;
                     if (V[x] > V[y]) {
@@ -340,14 +419,12 @@ int CHIP8_EMULATECYCLE(double deltaTime)
                 break;
 
                 case 0x0006:
-                    printf("# Set V%01X = V%01X SHR 1. VF set to least-significant bit, then V%01X divided by 2\n", (opcode & 0x0F00) >> 8, (opcode & 0x0F00) >> 8, (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     V[0xF] = V[x] & 0x1; // set to least-significant bit using mask
                     V[x] = V[x] >> 1;
                 break;
 
                 case 0x0007:
-                    printf("# Set V%01X = V%01X - V%01X, set VF = NOT borrow\n", (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4, (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     y = (opcode & 0x00F0) >> 4;
                     if (V[y] > V[x]) {
@@ -359,19 +436,16 @@ int CHIP8_EMULATECYCLE(double deltaTime)
                 break;
 
                 case 0x000E:
-                    printf("# Set V%01X = V%01X SHL 1. VF set to most-significant bit, then V%01X multiplied by 2\n", (opcode & 0x0F00) >> 8, (opcode & 0x0F00) >> 8, (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     V[0xF] = V[x] & 0x80; // set to most-significant bit using mask
                     V[x] = V[x] << 1;
                 break;
 
-                default:
-                    printf("Unknown opcode: 0x%X\n");
+                default: break;
             }
         break;
 
         case 0x9000:
-            printf("# Skip next if V%01X != V%01X\n", (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
             x = (opcode & 0x0F00) >> 8;
             y = (opcode & 0x00F0) >> 4;
             if (V[x] != V[y]) {
@@ -380,20 +454,17 @@ int CHIP8_EMULATECYCLE(double deltaTime)
         break;
 
         case 0xA000:
-            printf("# Set I = %03X\n", (opcode & 0x0FFF));
             nnn = (opcode & 0x0FFF);
             I = nnn;
         break;
 
         case 0xB000:
-            printf("# Jump to location %03X + V0\n", (opcode & 0x0FFF));
             nnn = (opcode & 0x0FFF);
             pc = (unsigned short)(nnn + (unsigned short)V[0]);
             incPc = false;
         break;
 
         case 0xC000:
-            printf("# Set V%01X = random byte AND %02X\n", (opcode & 0x0F00) >> 8, (opcode & 0x00FF));
             x = (opcode & 0x0F00) >> 8;
             kk = (opcode & 0x00FF);
             
@@ -401,7 +472,6 @@ int CHIP8_EMULATECYCLE(double deltaTime)
         break;
 
         case 0xD000:
-            printf("# Display %01X-byte sprite starting at memory location I at (V%01X, V%01X), set VF = collision\n", (opcode & 0x000F), (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
             x = (opcode & 0x0F00) >> 8;
             y = (opcode & 0x00F0) >> 4;
             n = (opcode & 0x000F);
@@ -431,7 +501,6 @@ int CHIP8_EMULATECYCLE(double deltaTime)
             switch(opcode & 0x00FF) 
             {
                 case 0x009E:
-                    printf("# Skip next if key with value V%0X pressed\n", (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     if (keyboardState[keybinds[V[x]]]) {
                         pc += 2;
@@ -439,15 +508,13 @@ int CHIP8_EMULATECYCLE(double deltaTime)
                 break;
 
                 case 0x00A1:
-                    printf("# Skip next if key with value V%0X not pressed\n", (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     if (!keyboardState[keybinds[V[x]]]) {
                         pc += 2;
                     }
                 break;
 
-                default:
-                    printf("Unknown opcode: 0x%X\n", opcode);
+                default: break;
             }
         break;
 
@@ -455,13 +522,11 @@ int CHIP8_EMULATECYCLE(double deltaTime)
             switch(opcode & 0x00FF)
             {
                 case 0x0007:
-                    printf("# Set V%01X = delay timer value\n", (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     V[x] = delay_timer;
                 break;
                 
                 case 0x000A:
-                    printf("# Wait for a key press, store the value of the key in V%01X\n", (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     bool found = false;
                     while (SDL_PollEvent(&ev) != 0) {
@@ -484,35 +549,31 @@ int CHIP8_EMULATECYCLE(double deltaTime)
                         incPc = true;
                     } else {
                         incPc = false;
+                        waitingForKey = true;
                     }
                 break;
                 
                 case 0x0015:
-                    printf("# Set delay timer = V%01X\n", (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     delay_timer = V[x];
                 break;
                 
                 case 0x0018:
-                    printf("# Set sound timer = V%01X\n", (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     sound_timer = V[x];
                 break;
                 
                 case 0x001E:
-                    printf("# Set I = I + V%01X\n", (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     I = I + V[x];
                 break;
                 
                 case 0x0029:
-                    printf("# Set I = location of sprite for digit V%01X\n", (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     I = 0x0000 + V[x] * 5; // digit font is kept starting at 0x0000, each digit takes up 0x20 (32) bits
                 break;
                 
                 case 0x0033:
-                    printf("# Store BCD representation of V%01X in memory locations I, I+1, I+2\n", (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     memory[I]     = V[x] / 100;
                     memory[I + 1] = (V[x] / 10) % 10;
@@ -521,7 +582,6 @@ int CHIP8_EMULATECYCLE(double deltaTime)
                 break;
                 
                 case 0x0055:
-                    printf("# Store registers V0 through V%01X in memory starting at location I\n", (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     for (int reg = 0; reg <= x; reg++) {
                         memory[I + reg] = V[reg];
@@ -529,20 +589,17 @@ int CHIP8_EMULATECYCLE(double deltaTime)
                 break;
                 
                 case 0x0065:
-                    printf("# Read registers V0 through V%01X from memory starting at location I\n", (opcode & 0x0F00) >> 8);
                     x = (opcode & 0x0F00) >> 8;
                     for (int reg = 0; reg <= x; reg++) {
                         V[reg] = memory[I + reg];
                     }
                 break;
                 
-                default:
-                    printf("Unknown opcode: 0x%X\n", opcode);
+                default: break;
             }
         break;
 
-        default:
-            printf("Unknown opcode: 0x%X\n", opcode);
+        default: break;
 
     }
 
@@ -550,5 +607,9 @@ int CHIP8_EMULATECYCLE(double deltaTime)
         pc += 2;
     }
 
+    if (!waitingForKey) {
+        instructionsExecuted++;
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -2,8 +2,17 @@
 #include <stdbool.h>
 #include "SDL2/SDL.h"
 #include "chip8-system.c"
+#include "chip8-metrics.c"
 #include <time.h>
 
+// build with -DCHIP8_DEBUG to run every cycle through the interactive debugger
+#ifdef CHIP8_DEBUG
+#include "chip8-debugger.c"
+#define EMULATECYCLE CHIP8_DEBUG_EMULATECYCLE
+#else
+#define EMULATECYCLE CHIP8_EMULATECYCLE
+#endif
+
 // must be divisible by (64, 32) and ideally have same aspect ratio
 #define WINDOWX 640
 #define WINDOWY 320
@@ -18,10 +27,6 @@ int main(int argc, char** argv) {
         printf("An error occurred while initializing the emulator. (check stderr)\n");
     }
 
-    // program stepping
-    bool stepping = false;
-
-
     // initialize graphics
     SDL_Window *window = NULL;
     SDL_Renderer *renderer = NULL;
@@ -49,6 +54,8 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    CHIP8_METRICS_INITIALIZE();
+
     SDL_Event ev;
 
     bool running = true; // game loop
@@ -77,23 +84,45 @@ int main(int argc, char** argv) {
         curr_time = SDL_GetPerformanceCounter();
         deltaTime = (double)((curr_time - start_time)*1000 / (double)SDL_GetPerformanceFrequency());
 
-        SDL_RenderClear(renderer);
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 1);
-        SDL_RenderFillRect(renderer, &fullscreen);
         while (SDL_PollEvent(&ev) != 0) {
             if (ev.type == SDL_QUIT) {
                 running = false;
+            } else if (ev.type == SDL_KEYDOWN && ev.key.keysym.scancode == SDL_SCANCODE_F1) {
+                overlayVisible = !overlayVisible;
             }
         }
-        int out = CHIP8_EMULATECYCLE(deltaTime);
+
+        // section timings for metrics (event handling above is not part of any section)
+        Uint64 section_start = SDL_GetPerformanceCounter();
+        Uint64 render_counts = 0;
+
+        SDL_RenderClear(renderer);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 1);
+        SDL_RenderFillRect(renderer, &fullscreen);
+        render_counts += SDL_GetPerformanceCounter() - section_start;
+
+        unsigned long ticks_before = timerTicks;
+        unsigned long instructions_before = instructionsExecuted;
+        section_start = SDL_GetPerformanceCounter();
+        int out = EMULATECYCLE(deltaTime);
+        Uint64 emulate_counts = SDL_GetPerformanceCounter() - section_start;
         if (out == 1) {
             printf("Program hit end, quitting\n");
+            CHIP8_METRICS_CLOSE();
             return 0;
         } else if (out == 2) {
             printf("Error during program, quitting\n");
+            CHIP8_METRICS_CLOSE();
             return 1;
+        } else if (out == 3) {
+            // only returned by the debugger
+            printf("Quit from debugger\n");
+            CHIP8_METRICS_CLOSE();
+            return 0;
         }
 
+        section_start = SDL_GetPerformanceCounter();
+
         // Display GFX
         SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
         for (int i = 0; i < SCREENY; i++) {
@@ -106,17 +135,32 @@ int main(int argc, char** argv) {
                 }
             }
         }
+        CHIP8_METRICS_DRAWOVERLAY(renderer, WINDOWX, WINDOWY);
+        render_counts += SDL_GetPerformanceCounter() - section_start;
 
-        if (stepping) {
-            char temp;
-            scanf("%c",&temp);
-        }
-
+        section_start = SDL_GetPerformanceCounter();
         SDL_PumpEvents();
         SDL_RenderPresent(renderer);
         SDL_UpdateWindowSurface(window);
+        Uint64 frame_end = SDL_GetPerformanceCounter();
+        Uint64 present_counts = frame_end - section_start;
+
+        // deltaTime is the previous iteration's period, so metrics measure this iteration from its start to the end of present
+        double frame_ms = (double)((frame_end - curr_time)*1000 / (double)SDL_GetPerformanceFrequency());
+
+#ifdef CHIP8_DEBUG
+        // time spent at the prompt is not frame time, so a frame that stopped there is not recorded
+        bool record_frame = !debug_discardDelta;
+#else
+        bool record_frame = true;
+#endif
+        if (record_frame) {
+            CHIP8_METRICS_ENDFRAME(frame_ms, instructionsExecuted - instructions_before, timerTicks - ticks_before, emulate_counts, render_counts, present_counts);
+        }
     }
 
+    CHIP8_METRICS_CLOSE();
+
 
     SDL_DestroyWindow(window);
 